@@ -0,0 +1,294 @@
+#include "CompressedBitset.hpp"
+#include <algorithm>
+#include <bitset>
+#include <iterator>
+
+namespace
+{
+    uint32_t popcount(uint64_t word)
+    {
+        return (uint32_t)std::bitset<64>(word).count();
+    }
+}
+
+bool CompressedBitset::Chunk::contains(uint16_t low) const
+{
+    if (isBitmap()) return (bitmap[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void CompressedBitset::Chunk::toBitmap()
+{
+    if (isBitmap()) return;
+    bitmap.assign(bitmapWords, 0);
+    for (uint16_t low : array)
+    {
+        bitmap[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void CompressedBitset::Chunk::normalize()
+{
+    if (isBitmap())
+    {
+        if (count > arrayLimit) return;
+        array.clear();
+        array.reserve(count);
+        for (size_t w = 0; w < bitmapWords; w++)
+        {
+            uint64_t word = bitmap[w];
+            while (word)
+            {
+                uint64_t lowest = word & (~word + 1);
+                array.push_back((uint16_t)(w * 64 + popcount(lowest - 1)));
+                word ^= lowest;
+            }
+        }
+        bitmap.clear();
+        bitmap.shrink_to_fit();
+    }
+    else
+    {
+        count = (uint32_t)array.size();
+        if (count > arrayLimit) toBitmap();
+    }
+}
+
+CompressedBitset::Chunk* CompressedBitset::findChunk(uint16_t key)
+{
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+        [](const Chunk& chunk, uint16_t k) { return chunk.key < k; });
+    return (it != chunks.end() && it->key == key) ? &*it : nullptr;
+}
+
+const CompressedBitset::Chunk* CompressedBitset::findChunk(uint16_t key) const
+{
+    return const_cast<CompressedBitset*>(this)->findChunk(key);
+}
+
+void CompressedBitset::add(uint32_t id)
+{
+    uint16_t key = (uint16_t)(id >> 16);
+    uint16_t low = (uint16_t)(id & 0xFFFF);
+
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+        [](const Chunk& chunk, uint16_t k) { return chunk.key < k; });
+    if (it == chunks.end() || it->key != key)
+    {
+        Chunk chunk;
+        chunk.key = key;
+        it = chunks.insert(it, std::move(chunk));
+    }
+
+    Chunk& chunk = *it;
+    if (chunk.isBitmap())
+    {
+        uint64_t& word = chunk.bitmap[low >> 6];
+        uint64_t bit = uint64_t(1) << (low & 63);
+        if (!(word & bit))
+        {
+            word |= bit;
+            chunk.count++;
+        }
+        return;
+    }
+
+    auto pos = std::lower_bound(chunk.array.begin(), chunk.array.end(), low);
+    if (pos != chunk.array.end() && *pos == low) return;
+    chunk.array.insert(pos, low);
+    chunk.normalize();
+}
+
+void CompressedBitset::remove(uint32_t id)
+{
+    uint16_t low = (uint16_t)(id & 0xFFFF);
+    Chunk* chunk = findChunk((uint16_t)(id >> 16));
+    if (!chunk || !chunk->contains(low)) return;
+
+    if (chunk->isBitmap())
+    {
+        chunk->bitmap[low >> 6] &= ~(uint64_t(1) << (low & 63));
+        chunk->count--;
+    }
+    else
+    {
+        chunk->array.erase(std::lower_bound(chunk->array.begin(), chunk->array.end(), low));
+    }
+    chunk->normalize();
+
+    if (chunk->count == 0)
+    {
+        chunks.erase(chunks.begin() + (chunk - chunks.data()));
+    }
+}
+
+bool CompressedBitset::contains(uint32_t id) const
+{
+    const Chunk* chunk = findChunk((uint16_t)(id >> 16));
+    return chunk && chunk->contains((uint16_t)(id & 0xFFFF));
+}
+
+size_t CompressedBitset::cardinality() const
+{
+    size_t total = 0;
+    for (const Chunk& chunk : chunks) total += chunk.count;
+    return total;
+}
+
+std::vector<uint32_t> CompressedBitset::toVector() const
+{
+    std::vector<uint32_t> ids;
+    ids.reserve(cardinality());
+    for (const Chunk& chunk : chunks)
+    {
+        uint32_t high = (uint32_t)chunk.key << 16;
+        if (!chunk.isBitmap())
+        {
+            for (uint16_t low : chunk.array) ids.push_back(high | low);
+            continue;
+        }
+        for (size_t w = 0; w < bitmapWords; w++)
+        {
+            uint64_t word = chunk.bitmap[w];
+            while (word)
+            {
+                uint64_t lowest = word & (~word + 1);
+                ids.push_back(high | (uint32_t)(w * 64 + popcount(lowest - 1)));
+                word ^= lowest;
+            }
+        }
+    }
+    return ids;
+}
+
+CompressedBitset CompressedBitset::range(uint32_t count)
+{
+    CompressedBitset result;
+    for (uint32_t start = 0; start < count; start += 0x10000)
+    {
+        uint32_t size = std::min<uint32_t>(count - start, 0x10000);
+        Chunk chunk;
+        chunk.key = (uint16_t)(start >> 16);
+        chunk.bitmap.assign(bitmapWords, 0);
+        for (uint32_t w = 0; w < size / 64; w++) chunk.bitmap[w] = ~uint64_t(0);
+        if (size % 64) chunk.bitmap[size / 64] = (uint64_t(1) << (size % 64)) - 1;
+        chunk.count = size;
+        chunk.normalize();
+        result.chunks.push_back(std::move(chunk));
+    }
+    return result;
+}
+
+CompressedBitset::Chunk CompressedBitset::combine(const Chunk& a, const Chunk& b, Op op)
+{
+    Chunk result;
+    result.key = a.key;
+
+    if (!a.isBitmap() && !b.isBitmap())
+    {
+        auto out = std::back_inserter(result.array);
+        if (op == Op::And) std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), out);
+        else if (op == Op::Or) std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), out);
+        else std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), out);
+        result.normalize();
+        return result;
+    }
+
+    // Sparse side against a bitmap only needs a membership probe per element.
+    if (op == Op::And && (!a.isBitmap() || !b.isBitmap()))
+    {
+        const Chunk& sparse = a.isBitmap() ? b : a;
+        const Chunk& dense = a.isBitmap() ? a : b;
+        for (uint16_t low : sparse.array)
+        {
+            if (dense.contains(low)) result.array.push_back(low);
+        }
+        result.normalize();
+        return result;
+    }
+    if (op == Op::AndNot && !a.isBitmap())
+    {
+        for (uint16_t low : a.array)
+        {
+            if (!b.contains(low)) result.array.push_back(low);
+        }
+        result.normalize();
+        return result;
+    }
+
+    Chunk left = a;
+    Chunk right = b;
+    left.toBitmap();
+    right.toBitmap();
+    result.bitmap.resize(bitmapWords);
+    for (size_t w = 0; w < bitmapWords; w++)
+    {
+        uint64_t word;
+        if (op == Op::And) word = left.bitmap[w] & right.bitmap[w];
+        else if (op == Op::Or) word = left.bitmap[w] | right.bitmap[w];
+        else word = left.bitmap[w] & ~right.bitmap[w];
+        result.bitmap[w] = word;
+        result.count += popcount(word);
+    }
+    result.normalize();
+    return result;
+}
+
+CompressedBitset CompressedBitset::operator&(const CompressedBitset& other) const
+{
+    CompressedBitset result;
+    auto a = chunks.begin();
+    auto b = other.chunks.begin();
+    while (a != chunks.end() && b != other.chunks.end())
+    {
+        if (a->key < b->key) ++a;
+        else if (b->key < a->key) ++b;
+        else
+        {
+            Chunk chunk = combine(*a, *b, Op::And);
+            if (chunk.count) result.chunks.push_back(std::move(chunk));
+            ++a;
+            ++b;
+        }
+    }
+    return result;
+}
+
+CompressedBitset CompressedBitset::operator|(const CompressedBitset& other) const
+{
+    CompressedBitset result;
+    auto a = chunks.begin();
+    auto b = other.chunks.begin();
+    while (a != chunks.end() || b != other.chunks.end())
+    {
+        if (b == other.chunks.end() || (a != chunks.end() && a->key < b->key)) result.chunks.push_back(*a++);
+        else if (a == chunks.end() || b->key < a->key) result.chunks.push_back(*b++);
+        else
+        {
+            result.chunks.push_back(combine(*a, *b, Op::Or));
+            ++a;
+            ++b;
+        }
+    }
+    return result;
+}
+
+CompressedBitset CompressedBitset::andNot(const CompressedBitset& other) const
+{
+    CompressedBitset result;
+    auto b = other.chunks.begin();
+    for (const Chunk& chunk : chunks)
+    {
+        while (b != other.chunks.end() && b->key < chunk.key) ++b;
+        if (b == other.chunks.end() || b->key != chunk.key)
+        {
+            result.chunks.push_back(chunk);
+            continue;
+        }
+        Chunk combined = combine(chunk, *b, Op::AndNot);
+        if (combined.count) result.chunks.push_back(std::move(combined));
+    }
+    return result;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set of 32-bit ids split into 65536-wide chunks. Sparse chunks keep a sorted
+// array of the low 16 bits, dense chunks switch to a 1024-word bitmap, so both
+// rare tags and tags on most of the vault stay small and fast to intersect.
+class CompressedBitset
+{
+public:
+    void add(uint32_t id);
+    void remove(uint32_t id);
+    bool contains(uint32_t id) const;
+    bool empty() const { return chunks.empty(); }
+    size_t cardinality() const;
+    std::vector<uint32_t> toVector() const;
+
+    static CompressedBitset range(uint32_t count);
+
+    CompressedBitset operator&(const CompressedBitset& other) const;
+    CompressedBitset operator|(const CompressedBitset& other) const;
+    CompressedBitset andNot(const CompressedBitset& other) const;
+
+private:
+    static constexpr size_t arrayLimit = 4096;
+    static constexpr size_t bitmapWords = 1024;
+
+    struct Chunk
+    {
+        uint16_t key = 0;
+        std::vector<uint16_t> array;
+        std::vector<uint64_t> bitmap;
+        uint32_t count = 0;
+
+        bool isBitmap() const { return !bitmap.empty(); }
+        bool contains(uint16_t low) const;
+        void toBitmap();
+        void normalize();
+    };
+
+    std::vector<Chunk> chunks;
+
+    Chunk* findChunk(uint16_t key);
+    const Chunk* findChunk(uint16_t key) const;
+
+    enum class Op { And, Or, AndNot };
+    static Chunk combine(const Chunk& a, const Chunk& b, Op op);
+};
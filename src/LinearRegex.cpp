@@ -0,0 +1,672 @@
+#include "LinearRegex.hpp"
+#include <cctype>
+
+namespace
+{
+    const size_t npos = std::string::npos;
+    const size_t maxProgramSize = 20000;
+    const int maxRepeat = 1000;
+
+    struct Node
+    {
+        enum class Kind { Empty, Set, LineStart, LineEnd, WordBoundary, NotWordBoundary, Concat, Alt, Repeat, Group };
+
+        Kind kind = Kind::Empty;
+        std::bitset<256> set;
+        std::vector<Node> children;
+        int min = 0;
+        int max = 0;
+        bool greedy = true;
+        int group = -1;
+    };
+
+    bool isWordChar(unsigned char c)
+    {
+        return std::isalnum(c) || c == '_';
+    }
+
+    std::bitset<256> classSet(char kind)
+    {
+        std::bitset<256> set;
+        for (int c = 0; c < 256; c++)
+        {
+            bool in = false;
+            switch (std::tolower((unsigned char)kind))
+            {
+            case 'd': in = c >= '0' && c <= '9'; break;
+            case 'w': in = c < 128 && isWordChar((unsigned char)c); break;
+            case 's': in = c == ' ' || (c >= '\t' && c <= '\r'); break;
+            }
+            set[c] = in;
+        }
+        if (std::isupper((unsigned char)kind)) set.flip();
+        return set;
+    }
+
+    int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+class RegexCompiler
+{
+public:
+    RegexCompiler(LinearRegex& target, const std::string& pattern, bool caseSensitive)
+        : re(target), text(pattern), foldCase(!caseSensitive)
+    {
+    }
+
+    bool run(std::string& error)
+    {
+        Node root;
+        if (!parseAlt(root)) { error = message; return false; }
+        if (pos < text.size()) { error = "Unmatched ')'"; return false; }
+
+        re.program.clear();
+        re.sets.clear();
+        re.slotCount = 2 * (groupCount + 1);
+        emit(LinearRegex::Op::Save, 0);
+        if (!compile(root)) { error = message; return false; }
+        emit(LinearRegex::Op::Save, 1);
+        emit(LinearRegex::Op::Match);
+        if (re.program.size() > maxProgramSize) { error = "Pattern is too large"; return false; }
+        re.computePrefilter();
+        return true;
+    }
+
+private:
+    using Op = LinearRegex::Op;
+
+    LinearRegex& re;
+    const std::string& text;
+    bool foldCase;
+    size_t pos = 0;
+    int groupCount = 0;
+    std::string message;
+
+    bool fail(const std::string& reason)
+    {
+        message = reason;
+        return false;
+    }
+
+    bool atEnd() const { return pos >= text.size(); }
+
+    bool parseAlt(Node& out)
+    {
+        Node first;
+        if (!parseConcat(first)) return false;
+        if (atEnd() || text[pos] != '|')
+        {
+            out = std::move(first);
+            return true;
+        }
+
+        out.kind = Node::Kind::Alt;
+        out.children.push_back(std::move(first));
+        while (!atEnd() && text[pos] == '|')
+        {
+            pos++;
+            Node next;
+            if (!parseConcat(next)) return false;
+            out.children.push_back(std::move(next));
+        }
+        return true;
+    }
+
+    bool parseConcat(Node& out)
+    {
+        out.kind = Node::Kind::Concat;
+        while (!atEnd() && text[pos] != '|' && text[pos] != ')')
+        {
+            Node atom;
+            if (!parseRepeat(atom)) return false;
+            out.children.push_back(std::move(atom));
+        }
+        return true;
+    }
+
+    bool parseCount(int& value)
+    {
+        size_t start = pos;
+        value = 0;
+        while (!atEnd() && std::isdigit((unsigned char)text[pos]))
+        {
+            value = std::min(value * 10 + (text[pos] - '0'), maxRepeat + 1);
+            pos++;
+        }
+        return pos > start;
+    }
+
+    bool parseRepeat(Node& out)
+    {
+        Node atom;
+        if (!parseAtom(atom)) return false;
+
+        while (!atEnd())
+        {
+            int min = 0;
+            int max = -1;
+            char c = text[pos];
+            if (c == '*') { pos++; }
+            else if (c == '+') { pos++; min = 1; }
+            else if (c == '?') { pos++; max = 1; }
+            else if (c == '{')
+            {
+                // Anything that is not a valid {m}, {m,} or {m,n} is a literal '{'.
+                size_t save = pos++;
+                if (!parseCount(min)) { pos = save; break; }
+                max = min;
+                if (!atEnd() && text[pos] == ',')
+                {
+                    pos++;
+                    max = -1;
+                    if (!atEnd() && text[pos] != '}' && !parseCount(max)) { pos = save; break; }
+                }
+                if (atEnd() || text[pos] != '}') { pos = save; break; }
+                pos++;
+                if (min > maxRepeat || max > maxRepeat) return fail("Repeat count is too large");
+                if (max != -1 && max < min) return fail("Invalid repeat range");
+            }
+            else break;
+
+            if (atom.kind == Node::Kind::LineStart || atom.kind == Node::Kind::LineEnd
+                || atom.kind == Node::Kind::WordBoundary || atom.kind == Node::Kind::NotWordBoundary)
+            {
+                return fail("Nothing to repeat");
+            }
+
+            Node repeat;
+            repeat.kind = Node::Kind::Repeat;
+            repeat.min = min;
+            repeat.max = max;
+            if (!atEnd() && text[pos] == '?')
+            {
+                repeat.greedy = false;
+                pos++;
+            }
+            repeat.children.push_back(std::move(atom));
+            atom = std::move(repeat);
+        }
+
+        out = std::move(atom);
+        return true;
+    }
+
+    bool parseEscape(std::bitset<256>& set, bool inClass)
+    {
+        if (atEnd()) return fail("Trailing backslash");
+        char c = text[pos++];
+        switch (c)
+        {
+        case 'd': case 'D': case 'w': case 'W': case 's': case 'S':
+            set |= classSet(c);
+            return true;
+        case 'n': set.set('\n'); return true;
+        case 't': set.set('\t'); return true;
+        case 'r': set.set('\r'); return true;
+        case 'f': set.set('\f'); return true;
+        case 'v': set.set('\v'); return true;
+        case '0': set.set(0); return true;
+        case 'b': if (inClass) { set.set('\b'); return true; } break;
+        case 'x':
+        {
+            if (pos + 1 >= text.size() || hexValue(text[pos]) < 0 || hexValue(text[pos + 1]) < 0)
+            {
+                return fail("Invalid \\x escape");
+            }
+            set.set((size_t)(hexValue(text[pos]) * 16 + hexValue(text[pos + 1])));
+            pos += 2;
+            return true;
+        }
+        default:
+            break;
+        }
+        if (c >= '1' && c <= '9') return fail("Backreferences are not supported");
+        set.set((unsigned char)c);
+        return true;
+    }
+
+    bool parseClass(Node& out)
+    {
+        out.kind = Node::Kind::Set;
+        bool negate = !atEnd() && text[pos] == '^';
+        if (negate) pos++;
+
+        bool first = true;
+        while (!atEnd() && (text[pos] != ']' || first))
+        {
+            first = false;
+            std::bitset<256> item;
+            int low = -1;
+            if (text[pos] == '\\')
+            {
+                pos++;
+                if (!parseEscape(item, true)) return false;
+                if (item.count() == 1) for (int c = 0; c < 256; c++) if (item[c]) low = c;
+            }
+            else
+            {
+                low = (unsigned char)text[pos++];
+                item.set((size_t)low);
+            }
+
+            if (low >= 0 && pos + 1 < text.size() && text[pos] == '-' && text[pos + 1] != ']')
+            {
+                pos++;
+                std::bitset<256> upperItem;
+                int high;
+                if (text[pos] == '\\')
+                {
+                    pos++;
+                    if (!parseEscape(upperItem, true)) return false;
+                    if (upperItem.count() != 1) return fail("Invalid class range");
+                    high = 0;
+                    while (!upperItem[high]) high++;
+                }
+                else
+                {
+                    high = (unsigned char)text[pos++];
+                }
+                if (high < low) return fail("Invalid class range");
+                for (int c = low; c <= high; c++) item.set((size_t)c);
+            }
+            out.set |= item;
+        }
+        if (atEnd()) return fail("Missing ']'");
+        pos++;
+        fold(out.set);
+        if (negate) out.set.flip();
+        return true;
+    }
+
+    bool parseAtom(Node& out)
+    {
+        char c = text[pos++];
+        switch (c)
+        {
+        case '(':
+        {
+            if (!atEnd() && text[pos] == '?')
+            {
+                if (pos + 1 < text.size() && text[pos + 1] == ':') pos += 2;
+                else return fail("Lookaround and inline flags are not supported");
+                if (!parseAlt(out)) return false;
+            }
+            else
+            {
+                out.kind = Node::Kind::Group;
+                out.group = ++groupCount;
+                Node inner;
+                if (!parseAlt(inner)) return false;
+                out.children.push_back(std::move(inner));
+            }
+            if (atEnd() || text[pos] != ')') return fail("Missing ')'");
+            pos++;
+            return true;
+        }
+        case ')':
+            return fail("Unmatched ')'");
+        case '[':
+            return parseClass(out);
+        case '.':
+            out.kind = Node::Kind::Set;
+            out.set.set();
+            out.set.reset('\n');
+            out.set.reset('\r');
+            return true;
+        case '^':
+            out.kind = Node::Kind::LineStart;
+            return true;
+        case '$':
+            out.kind = Node::Kind::LineEnd;
+            return true;
+        case '*': case '+': case '?':
+            return fail("Nothing to repeat");
+        case '\\':
+            if (!atEnd() && (text[pos] == 'b' || text[pos] == 'B'))
+            {
+                out.kind = text[pos++] == 'b' ? Node::Kind::WordBoundary : Node::Kind::NotWordBoundary;
+                return true;
+            }
+            out.kind = Node::Kind::Set;
+            if (!parseEscape(out.set, false)) return false;
+            fold(out.set);
+            return true;
+        default:
+            out.kind = Node::Kind::Set;
+            out.set.set((unsigned char)c);
+            fold(out.set);
+            return true;
+        }
+    }
+
+    int emit(Op op, int x = 0, int y = 0)
+    {
+        re.program.push_back({ op, x, y });
+        return (int)re.program.size() - 1;
+    }
+
+    int addSet(const std::bitset<256>& set)
+    {
+        re.sets.push_back(set);
+        return (int)re.sets.size() - 1;
+    }
+
+    // Case folding has to happen before a class is negated, so [^a] excludes 'A' too.
+    void fold(std::bitset<256>& set) const
+    {
+        if (!foldCase) return;
+        for (int c = 0; c < 256; c++)
+        {
+            if (!set[c]) continue;
+            set.set((size_t)(unsigned char)std::tolower(c));
+            set.set((size_t)(unsigned char)std::toupper(c));
+        }
+    }
+
+    bool compile(const Node& node)
+    {
+        if (re.program.size() > maxProgramSize) return fail("Pattern is too large");
+
+        switch (node.kind)
+        {
+        case Node::Kind::Empty:
+            return true;
+        case Node::Kind::Set:
+            emit(Op::Set, addSet(node.set));
+            return true;
+        case Node::Kind::LineStart: emit(Op::LineStart); return true;
+        case Node::Kind::LineEnd: emit(Op::LineEnd); return true;
+        case Node::Kind::WordBoundary: emit(Op::WordBoundary); return true;
+        case Node::Kind::NotWordBoundary: emit(Op::NotWordBoundary); return true;
+        case Node::Kind::Concat:
+            for (const Node& child : node.children)
+            {
+                if (!compile(child)) return false;
+            }
+            return true;
+        case Node::Kind::Group:
+            emit(Op::Save, 2 * node.group);
+            if (!compile(node.children[0])) return false;
+            emit(Op::Save, 2 * node.group + 1);
+            return true;
+        case Node::Kind::Alt:
+        {
+            std::vector<int> jumps;
+            for (size_t i = 0; i < node.children.size(); i++)
+            {
+                int split = -1;
+                if (i + 1 < node.children.size()) split = emit(Op::Split);
+                if (split >= 0) re.program[split].x = split + 1;
+                if (!compile(node.children[i])) return false;
+                if (split >= 0)
+                {
+                    jumps.push_back(emit(Op::Jmp));
+                    re.program[split].y = (int)re.program.size();
+                }
+            }
+            for (int jump : jumps) re.program[jump].x = (int)re.program.size();
+            return true;
+        }
+        case Node::Kind::Repeat:
+            return compileRepeat(node);
+        }
+        return true;
+    }
+
+    // Split that prefers 'preferred' when greedy and the other branch when lazy.
+    void patchSplit(int split, int body, int exit, bool greedy)
+    {
+        re.program[split].x = greedy ? body : exit;
+        re.program[split].y = greedy ? exit : body;
+    }
+
+    bool compileRepeat(const Node& node)
+    {
+        const Node& body = node.children[0];
+        for (int i = 0; i < node.min; i++)
+        {
+            if (!compile(body)) return false;
+        }
+
+        if (node.max == -1)
+        {
+            int split = emit(Op::Split);
+            if (!compile(body)) return false;
+            emit(Op::Jmp, split);
+            patchSplit(split, split + 1, (int)re.program.size(), node.greedy);
+            return true;
+        }
+
+        std::vector<int> splits;
+        for (int i = node.min; i < node.max; i++)
+        {
+            splits.push_back(emit(Op::Split));
+            if (!compile(body)) return false;
+        }
+        for (int split : splits) patchSplit(split, split + 1, (int)re.program.size(), node.greedy);
+        return true;
+    }
+};
+
+bool LinearRegex::compile(const std::string& pattern, bool caseSensitive, std::string& error)
+{
+    RegexCompiler compiler(*this, pattern, caseSensitive);
+    return compiler.run(error);
+}
+
+void LinearRegex::computePrefilter()
+{
+    // A pattern that starts with fixed bytes lets the search jump with string_view::find.
+    literalPrefix.clear();
+    for (size_t pc = 0; pc < program.size(); pc++)
+    {
+        const Inst& inst = program[pc];
+        // Zero-width steps only narrow where a match may start.
+        if (inst.op != Op::Set && inst.op != Op::Split && inst.op != Op::Jmp && inst.op != Op::Match) continue;
+        if (inst.op != Op::Set || sets[inst.x].count() != 1) break;
+        for (int c = 0; c < 256; c++)
+        {
+            if (sets[inst.x][c]) literalPrefix += (char)c;
+        }
+    }
+
+    // Bytes that can start a match; only valid if every path from the start consumes one.
+    firstBytes.reset();
+    usePrefilter = true;
+    std::vector<bool> seen(program.size(), false);
+    std::vector<int> stack{ 0 };
+    while (!stack.empty())
+    {
+        int pc = stack.back();
+        stack.pop_back();
+        if (seen[pc]) continue;
+        seen[pc] = true;
+
+        const Inst& inst = program[pc];
+        switch (inst.op)
+        {
+        case Op::Set: firstBytes |= sets[inst.x]; break;
+        case Op::Split: stack.push_back(inst.x); stack.push_back(inst.y); break;
+        case Op::Jmp: stack.push_back(inst.x); break;
+        case Op::Match: usePrefilter = false; break;
+        default: stack.push_back(pc + 1); break;
+        }
+    }
+}
+
+void LinearRegex::addThread(ThreadList& list, int pc, std::string_view text, size_t pos,
+    std::vector<size_t>& caps, std::vector<Frame>& stack) const
+{
+    // Frames with slot >= 0 restore a capture once the branch below a Save is explored.
+    stack.clear();
+    stack.push_back({ pc, -1, 0 });
+    while (!stack.empty())
+    {
+        Frame frame = stack.back();
+        stack.pop_back();
+        if (frame.slot >= 0)
+        {
+            caps[frame.slot] = frame.value;
+            continue;
+        }
+
+        int entry = frame.pc;
+        if (list.sparse[entry] < (int)list.dense.size() && list.dense[list.sparse[entry]] == entry) continue;
+        list.sparse[entry] = (int)list.dense.size();
+        list.dense.push_back(entry);
+
+        const Inst& inst = program[entry];
+        switch (inst.op)
+        {
+        case Op::Jmp:
+            stack.push_back({ inst.x, -1, 0 });
+            break;
+        case Op::Split:
+            stack.push_back({ inst.y, -1, 0 });
+            stack.push_back({ inst.x, -1, 0 });
+            break;
+        case Op::Save:
+            stack.push_back({ 0, inst.x, caps[inst.x] });
+            caps[inst.x] = pos;
+            stack.push_back({ entry + 1, -1, 0 });
+            break;
+        case Op::LineStart:
+            if (pos == 0 || text[pos - 1] == '\n') stack.push_back({ entry + 1, -1, 0 });
+            break;
+        case Op::LineEnd:
+            if (pos == text.size() || text[pos] == '\n' || text[pos] == '\r') stack.push_back({ entry + 1, -1, 0 });
+            break;
+        case Op::WordBoundary:
+        case Op::NotWordBoundary:
+        {
+            bool before = pos > 0 && isWordChar((unsigned char)text[pos - 1]);
+            bool after = pos < text.size() && isWordChar((unsigned char)text[pos]);
+            if ((before != after) == (inst.op == Op::WordBoundary)) stack.push_back({ entry + 1, -1, 0 });
+            break;
+        }
+        case Op::Set:
+        case Op::Match:
+            std::copy(caps.begin(), caps.end(), list.caps.begin() + (size_t)entry * slotCount);
+            break;
+        }
+    }
+}
+
+bool LinearRegex::search(std::string_view text, size_t start, ThreadList& clist, ThreadList& nlist,
+    std::vector<size_t>& work, std::vector<Frame>& stack, Match& match) const
+{
+    clist.dense.clear();
+    bool matched = false;
+
+    for (size_t pos = start; ; pos++)
+    {
+        if (!matched)
+        {
+            if (clist.dense.empty() && !literalPrefix.empty())
+            {
+                pos = text.find(literalPrefix, pos);
+                if (pos == std::string_view::npos) break;
+            }
+            else if (clist.dense.empty() && usePrefilter)
+            {
+                while (pos < text.size() && !firstBytes[(unsigned char)text[pos]]) pos++;
+                if (pos >= text.size()) break;
+            }
+            std::fill(work.begin(), work.end(), npos);
+            addThread(clist, 0, text, pos, work, stack);
+        }
+        if (clist.dense.empty()) break;
+
+        nlist.dense.clear();
+        for (int pc : clist.dense)
+        {
+            const Inst& inst = program[pc];
+            const size_t* caps = clist.caps.data() + (size_t)pc * slotCount;
+            if (inst.op == Op::Match)
+            {
+                // Empty matches are never useful to replace, so they do not count.
+                if (caps[0] == pos) continue;
+                match.groups.assign(caps, caps + slotCount);
+                matched = true;
+                // Lower priority threads can only produce less preferred matches.
+                break;
+            }
+            if (inst.op == Op::Set && pos < text.size() && sets[inst.x][(unsigned char)text[pos]])
+            {
+                work.assign(caps, caps + slotCount);
+                addThread(nlist, pc + 1, text, pos + 1, work, stack);
+            }
+        }
+        std::swap(clist, nlist);
+        if (pos >= text.size()) break;
+    }
+
+    if (!matched) return false;
+    match.offset = match.groups[0];
+    match.length = match.groups[1] - match.groups[0];
+    return true;
+}
+
+void LinearRegex::findAll(std::string_view text, std::vector<Match>& matches) const
+{
+    if (program.empty()) return;
+
+    ThreadList clist;
+    ThreadList nlist;
+    for (ThreadList* list : { &clist, &nlist })
+    {
+        list->sparse.assign(program.size(), 0);
+        list->dense.reserve(program.size());
+        list->caps.assign(program.size() * (size_t)slotCount, npos);
+    }
+    std::vector<size_t> work((size_t)slotCount, npos);
+    std::vector<Frame> stack;
+
+    size_t start = 0;
+    Match match;
+    while (start < text.size() && search(text, start, clist, nlist, work, stack, match))
+    {
+        start = match.offset + match.length;
+        matches.push_back(match);
+    }
+}
+
+std::string LinearRegex::format(std::string_view text, const Match& match, const std::string& replacement)
+{
+    std::string out;
+    out.reserve(replacement.size());
+    for (size_t i = 0; i < replacement.size(); i++)
+    {
+        char c = replacement[i];
+        if (c != '$' || i + 1 >= replacement.size())
+        {
+            out += c;
+            continue;
+        }
+
+        char next = replacement[i + 1];
+        size_t group = npos;
+        if (next == '$') { out += '$'; i++; continue; }
+        if (next == '&') group = 0;
+        else if (next >= '0' && next <= '9') group = (size_t)(next - '0');
+
+        if (group == npos)
+        {
+            out += c;
+            continue;
+        }
+        i++;
+        if (2 * group + 1 < match.groups.size() && match.groups[2 * group] != npos && match.groups[2 * group + 1] != npos)
+        {
+            size_t from = match.groups[2 * group];
+            out.append(text.substr(from, match.groups[2 * group + 1] - from));
+        }
+    }
+    return out;
+}
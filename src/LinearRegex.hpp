@@ -0,0 +1,72 @@
+#pragma once
+#include <bitset>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Regex matcher that simulates the compiled NFA over the text (Pike VM)
+// instead of backtracking. Time is linear in the input, stack use does not
+// depend on it, and one compiled pattern can be shared between threads.
+//
+// Supports ECMAScript-style literals and escapes, ., [classes], \d \w \s (and
+// negations), ^ $ (per line), \b \B, groups (capturing and (?:...)),
+// alternation and greedy or lazy * + ? {m,n}. Backreferences and lookaround
+// are rejected at compile time.
+class LinearRegex
+{
+public:
+    struct Match
+    {
+        size_t offset = 0;
+        size_t length = 0;
+        // Start/end pairs for the whole match (index 0) and each group; npos if unset.
+        std::vector<size_t> groups;
+    };
+
+    bool compile(const std::string& pattern, bool caseSensitive, std::string& error);
+    // Appends every non-overlapping, non-empty match, leftmost first.
+    void findAll(std::string_view text, std::vector<Match>& matches) const;
+
+    // Expands $&, $0-$9 and $$ in 'replacement' for one match.
+    static std::string format(std::string_view text, const Match& match, const std::string& replacement);
+
+private:
+    enum class Op { Set, Split, Jmp, Save, LineStart, LineEnd, WordBoundary, NotWordBoundary, Match };
+
+    struct Inst
+    {
+        Op op;
+        int x = 0;
+        int y = 0;
+    };
+
+    struct Frame
+    {
+        int pc;
+        int slot;
+        size_t value;
+    };
+
+    struct ThreadList
+    {
+        std::vector<int> sparse;
+        std::vector<int> dense;
+        std::vector<size_t> caps;
+    };
+
+    std::vector<Inst> program;
+    std::vector<std::bitset<256>> sets;
+    std::bitset<256> firstBytes;
+    bool usePrefilter = false;
+    std::string literalPrefix;
+    int slotCount = 2;
+
+    bool search(std::string_view text, size_t start, ThreadList& clist, ThreadList& nlist,
+        std::vector<size_t>& work, std::vector<Frame>& stack, Match& match) const;
+    void addThread(ThreadList& list, int pc, std::string_view text, size_t pos,
+        std::vector<size_t>& caps, std::vector<Frame>& stack) const;
+    void computePrefilter();
+
+    friend class RegexCompiler;
+};
@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <map>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -12,6 +14,8 @@ struct Note
 	bool isDirty = false;
 	std::filesystem::file_time_type rawTime;
 	std::string displayTime;
+	std::vector<std::string> tags;
+	std::map<std::string, std::vector<std::string>> properties;
 
 	bool save()
 	{
@@ -0,0 +1,408 @@
+#include "NoteIndex.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    std::string toLower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(),
+            [](unsigned char c) { return (char)std::tolower(c); });
+        return text;
+    }
+
+    std::string trim(const std::string& text)
+    {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) return "";
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    std::string unquote(const std::string& text)
+    {
+        if (text.size() >= 2 && (text.front() == '"' || text.front() == '\'') && text.back() == text.front())
+        {
+            return text.substr(1, text.size() - 2);
+        }
+        return text;
+    }
+
+    bool isTagChar(unsigned char c)
+    {
+        return std::isalnum(c) || c == '_' || c == '-' || c == '/' || c >= 0x80;
+    }
+
+    bool isTagKey(const std::string& key)
+    {
+        return key == "tags" || key == "tag";
+    }
+
+    void addTag(Note& note, std::string tag)
+    {
+        if (!tag.empty() && tag.front() == '#') tag.erase(0, 1);
+        tag = toLower(trim(tag));
+        if (tag.empty()) return;
+        if (std::find(note.tags.begin(), note.tags.end(), tag) == note.tags.end())
+        {
+            note.tags.push_back(tag);
+        }
+    }
+
+    void addValue(Note& note, const std::string& key, const std::string& rawValue)
+    {
+        std::string value = unquote(trim(rawValue));
+        if (value.empty()) return;
+
+        if (!isTagKey(key))
+        {
+            note.properties[key].push_back(value);
+            return;
+        }
+
+        // "tags: a, b" and "tags: a b" are both common outside strict YAML.
+        size_t start = 0;
+        while (start < value.size())
+        {
+            size_t end = value.find_first_of(", ", start);
+            if (end == std::string::npos) end = value.size();
+            addTag(note, unquote(value.substr(start, end - start)));
+            start = end + 1;
+        }
+    }
+
+    size_t parseFrontMatter(Note& note)
+    {
+        const std::string& text = note.content;
+        if (text.compare(0, 3, "---") != 0) return 0;
+
+        size_t lineEnd = text.find('\n');
+        if (lineEnd == std::string::npos || trim(text.substr(0, lineEnd)) != "---") return 0;
+
+        std::string currentKey;
+        size_t pos = lineEnd + 1;
+        while (pos < text.size())
+        {
+            lineEnd = text.find('\n', pos);
+            if (lineEnd == std::string::npos) lineEnd = text.size();
+            std::string line = text.substr(pos, lineEnd - pos);
+            std::string trimmed = trim(line);
+            pos = lineEnd + 1;
+
+            if (trimmed == "---" || trimmed == "...") return std::min(pos, text.size());
+            if (trimmed.empty() || trimmed[0] == '#') continue;
+
+            if (trimmed[0] == '-' && (trimmed.size() == 1 || trimmed[1] == ' '))
+            {
+                if (!currentKey.empty()) addValue(note, currentKey, trimmed.substr(1));
+                continue;
+            }
+
+            size_t colon = trimmed.find(':');
+            if (colon == std::string::npos) continue;
+
+            currentKey = toLower(trim(trimmed.substr(0, colon)));
+            std::string value = trim(trimmed.substr(colon + 1));
+            if (value.size() >= 2 && value.front() == '[' && value.back() == ']')
+            {
+                std::string items = value.substr(1, value.size() - 2);
+                size_t start = 0;
+                while (start <= items.size())
+                {
+                    size_t end = items.find(',', start);
+                    if (end == std::string::npos) end = items.size();
+                    addValue(note, currentKey, items.substr(start, end - start));
+                    start = end + 1;
+                }
+            }
+            else
+            {
+                addValue(note, currentKey, value);
+            }
+        }
+
+        // No closing fence: this was not front matter after all.
+        note.tags.clear();
+        note.properties.clear();
+        return 0;
+    }
+
+    void parseInlineTags(Note& note, size_t bodyStart)
+    {
+        const std::string& text = note.content;
+        bool inFence = false;
+        size_t pos = bodyStart;
+        while (pos < text.size())
+        {
+            size_t lineEnd = text.find('\n', pos);
+            if (lineEnd == std::string::npos) lineEnd = text.size();
+
+            size_t first = text.find_first_not_of(" \t", pos);
+            if (first < lineEnd && (text.compare(first, 3, "```") == 0 || text.compare(first, 3, "~~~") == 0))
+            {
+                inFence = !inFence;
+                pos = lineEnd + 1;
+                continue;
+            }
+
+            bool inCode = false;
+            for (size_t i = pos; !inFence && i < lineEnd; i++)
+            {
+                char c = text[i];
+                if (c == '`') inCode = !inCode;
+                if (inCode || c != '#') continue;
+
+                bool boundary = (i == pos) || std::isspace((unsigned char)text[i - 1]) || text[i - 1] == '(';
+                if (!boundary) continue;
+
+                size_t end = i + 1;
+                bool hasLetter = false;
+                while (end < lineEnd && isTagChar((unsigned char)text[end]))
+                {
+                    if (!std::isdigit((unsigned char)text[end])) hasLetter = true;
+                    end++;
+                }
+                if (hasLetter) addTag(note, text.substr(i + 1, end - i - 1));
+                i = end - 1;
+            }
+            pos = lineEnd + 1;
+        }
+    }
+}
+
+void NoteIndex::parseMetadata(Note& note)
+{
+    note.tags.clear();
+    note.properties.clear();
+    size_t bodyStart = parseFrontMatter(note);
+    parseInlineTags(note, bodyStart);
+}
+
+void NoteIndex::rebuild(const std::vector<Note>& notes)
+{
+    columns.clear();
+    noteTerms.clear();
+    titles.clear();
+    noteCount = 0;
+    for (uint32_t i = 0; i < (uint32_t)notes.size(); i++)
+    {
+        updateNote(i, notes[i]);
+    }
+    revision++;
+}
+
+void NoteIndex::removeTerms(uint32_t id)
+{
+    for (const Term& term : noteTerms[id])
+    {
+        auto column = columns.find(term.first);
+        if (column == columns.end()) continue;
+        auto value = column->second.find(term.second);
+        if (value == column->second.end()) continue;
+
+        value->second.remove(id);
+        if (value->second.empty()) column->second.erase(value);
+        if (column->second.empty()) columns.erase(column);
+    }
+    noteTerms[id].clear();
+}
+
+void NoteIndex::updateNote(uint32_t id, const Note& note)
+{
+    if (id >= noteCount)
+    {
+        noteCount = id + 1;
+        noteTerms.resize(noteCount);
+        titles.resize(noteCount);
+    }
+    removeTerms(id);
+
+    std::vector<Term>& terms = noteTerms[id];
+    for (const std::string& tag : note.tags)
+    {
+        terms.emplace_back("tag", tag);
+    }
+    for (const auto& [key, values] : note.properties)
+    {
+        for (const std::string& value : values)
+        {
+            terms.emplace_back(key, toLower(value));
+        }
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    for (const Term& term : terms)
+    {
+        columns[term.first][term.second].add(id);
+    }
+    titles[id] = toLower(note.title);
+    revision++;
+}
+
+bool NoteIndex::query(const std::string& text, CompressedBitset& result) const
+{
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        char c = text[i];
+        if (std::isspace((unsigned char)c))
+        {
+            i++;
+            continue;
+        }
+        if (c == '(' || c == ')')
+        {
+            tokens.push_back({ std::string(1, c), false });
+            i++;
+            continue;
+        }
+
+        Token token;
+        token.quoted = (c == '"');
+        while (i < text.size() && !std::isspace((unsigned char)text[i]) && text[i] != '(' && text[i] != ')')
+        {
+            if (text[i] == '"')
+            {
+                size_t close = text.find('"', i + 1);
+                if (close == std::string::npos) close = text.size();
+                token.text += text.substr(i + 1, close - i - 1);
+                i = std::min(close + 1, text.size());
+                continue;
+            }
+            token.text += text[i++];
+        }
+        tokens.push_back(token);
+    }
+
+    if (tokens.empty())
+    {
+        result = CompressedBitset::range(noteCount);
+        return true;
+    }
+
+    size_t pos = 0;
+    CompressedBitset out;
+    if (!parseOr(tokens, pos, out) || pos != tokens.size()) return false;
+    result = std::move(out);
+    return true;
+}
+
+bool NoteIndex::parseOr(const std::vector<Token>& tokens, size_t& pos, CompressedBitset& out) const
+{
+    if (!parseAnd(tokens, pos, out)) return false;
+    while (pos < tokens.size() && !tokens[pos].quoted && tokens[pos].text == "OR")
+    {
+        pos++;
+        CompressedBitset rhs;
+        if (!parseAnd(tokens, pos, rhs)) return false;
+        out = out | rhs;
+    }
+    return true;
+}
+
+bool NoteIndex::parseAnd(const std::vector<Token>& tokens, size_t& pos, CompressedBitset& out) const
+{
+    if (!parseNot(tokens, pos, out)) return false;
+    while (pos < tokens.size())
+    {
+        const Token& token = tokens[pos];
+        if (!token.quoted && (token.text == ")" || token.text == "OR")) break;
+        if (!token.quoted && token.text == "AND") pos++;
+
+        CompressedBitset rhs;
+        if (!parseNot(tokens, pos, rhs)) return false;
+        out = out & rhs;
+    }
+    return true;
+}
+
+bool NoteIndex::parseNot(const std::vector<Token>& tokens, size_t& pos, CompressedBitset& out) const
+{
+    if (pos < tokens.size() && !tokens[pos].quoted)
+    {
+        const Token& token = tokens[pos];
+        if (token.text == "NOT")
+        {
+            pos++;
+            CompressedBitset inner;
+            if (!parseNot(tokens, pos, inner)) return false;
+            out = CompressedBitset::range(noteCount).andNot(inner);
+            return true;
+        }
+        if (token.text.size() > 1 && token.text[0] == '-')
+        {
+            pos++;
+            out = CompressedBitset::range(noteCount).andNot(lookup({ token.text.substr(1), false }));
+            return true;
+        }
+    }
+    return parsePrimary(tokens, pos, out);
+}
+
+bool NoteIndex::parsePrimary(const std::vector<Token>& tokens, size_t& pos, CompressedBitset& out) const
+{
+    if (pos >= tokens.size()) return false;
+    const Token& token = tokens[pos];
+
+    if (!token.quoted)
+    {
+        if (token.text == "(")
+        {
+            pos++;
+            if (!parseOr(tokens, pos, out)) return false;
+            if (pos >= tokens.size() || tokens[pos].text != ")") return false;
+            pos++;
+            return true;
+        }
+        if (token.text == ")" || token.text == "AND" || token.text == "OR" || token.text == "NOT") return false;
+    }
+
+    out = lookup(token);
+    pos++;
+    return true;
+}
+
+CompressedBitset NoteIndex::lookup(const Token& token) const
+{
+    std::string column;
+    std::string value;
+    if (!token.quoted)
+    {
+        size_t colon = token.text.find(':');
+        if (token.text.size() > 1 && token.text[0] == '#')
+        {
+            column = "tag";
+            value = token.text.substr(1);
+        }
+        else if (colon != std::string::npos && colon > 0 && colon + 1 < token.text.size())
+        {
+            column = toLower(token.text.substr(0, colon));
+            value = token.text.substr(colon + 1);
+            if (isTagKey(column))
+            {
+                column = "tag";
+                if (value[0] == '#') value.erase(0, 1);
+            }
+        }
+    }
+
+    // A key no note uses is more likely part of a title ("10:30 standup") than a filter.
+    auto columnIt = column.empty() ? columns.end() : columns.find(column);
+    if (columnIt != columns.end())
+    {
+        auto valueIt = columnIt->second.find(toLower(value));
+        if (valueIt == columnIt->second.end()) return {};
+        return valueIt->second;
+    }
+
+    // Anything else filters on the title, like the plain search box always did.
+    CompressedBitset matches;
+    std::string needle = toLower(token.text);
+    for (uint32_t id = 0; id < noteCount; id++)
+    {
+        if (titles[id].find(needle) != std::string::npos) matches.add(id);
+    }
+    return matches;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Note.hpp"
+#include "CompressedBitset.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Columnar index over note metadata. Every front matter key is a column and
+// every value in it maps to the set of note ids carrying it; inline and front
+// matter tags live in the "tag" column. Note ids are positions in
+// NoteManager::notes.
+//
+// Query syntax: key:value, tag:name or #name, bare words matching titles,
+// combined with AND (or juxtaposition), OR, NOT / -term and parentheses.
+class NoteIndex
+{
+public:
+    // Fills note.tags and note.properties from YAML front matter and inline #tags.
+    static void parseMetadata(Note& note);
+
+    void rebuild(const std::vector<Note>& notes);
+    void updateNote(uint32_t id, const Note& note);
+
+    // Returns false if the query is malformed.
+    bool query(const std::string& text, CompressedBitset& result) const;
+
+    uint32_t size() const { return noteCount; }
+    uint64_t generation() const { return revision; }
+
+private:
+    struct Token
+    {
+        std::string text;
+        bool quoted = false;
+    };
+
+    using Term = std::pair<std::string, std::string>;
+
+    std::unordered_map<std::string, std::unordered_map<std::string, CompressedBitset>> columns;
+    std::vector<std::vector<Term>> noteTerms;
+    std::vector<std::string> titles;
+    uint32_t noteCount = 0;
+    uint64_t revision = 0;
+
+    void removeTerms(uint32_t id);
+
+    bool parseOr(const std::vector<Token>& tokens, size_t& pos, CompressedBitset& out) const;
+    bool parseAnd(const std::vector<Token>& tokens, size_t& pos, CompressedBitset& out) const;
+    bool parseNot(const std::vector<Token>& tokens, size_t& pos, CompressedBitset& out) const;
+    bool parsePrimary(const std::vector<Token>& tokens, size_t& pos, CompressedBitset& out) const;
+    CompressedBitset lookup(const Token& token) const;
+};
@@ -49,6 +49,7 @@ void NoteManager::refreshNotes()
             std::stringstream timeSS;
             timeSS << std::put_time(&timeinfo, "%Y-%m-%d %H:%M");
             newNote.displayTime = timeSS.str();
+            NoteIndex::parseMetadata(newNote);
             notes.emplace_back(newNote);
         }
     }
@@ -56,6 +57,8 @@ void NoteManager::refreshNotes()
         {
             return a.rawTime > b.rawTime;
         });
+    noteIndex.rebuild(notes);
+    similarityIndex.rebuild(notes);
 }
 
 Note* NoteManager::createNote(const std::string& title)
@@ -67,7 +70,10 @@ Note* NoteManager::createNote(const std::string& title)
     newNote.content = "# " + title + "\n\nStart writing...";
     newNote.filepath = notesDirectory + "/" + safeTitle;
     newNote.save();
+    NoteIndex::parseMetadata(newNote);
     notes.emplace_back(newNote);
+    noteIndex.updateNote((uint32_t)notes.size() - 1, notes.back());
+    similarityIndex.updateNote((uint32_t)notes.size() - 1, notes.back());
     return &notes.back();
 }
 
@@ -77,6 +83,8 @@ void NoteManager::deleteNote(int index)
     {
         fs::remove(notes[index].filepath);
         notes.erase(notes.begin() + index);
+        noteIndex.rebuild(notes);
+        similarityIndex.removeNote((uint32_t)index);
     }
 }
 
@@ -92,6 +100,7 @@ bool NoteManager::renameNote(int index, const std::string& newTitle)
         fs::rename(note.filepath, newPath);
         note.title = safeTitle;
         note.filepath = newPath;
+        noteIndex.updateNote((uint32_t)index, note);
         return true;
     }
     catch (const fs::filesystem_error& e)
@@ -101,3 +110,14 @@ bool NoteManager::renameNote(int index, const std::string& newTitle)
     }
     return false;
 }
+
+bool NoteManager::saveNote(int index)
+{
+    if (index < 0 || index >= (int)notes.size()) return false;
+    Note& note = notes[index];
+    if (!note.save()) return false;
+    NoteIndex::parseMetadata(note);
+    noteIndex.updateNote((uint32_t)index, note);
+    similarityIndex.updateNote((uint32_t)index, note);
+    return true;
+}
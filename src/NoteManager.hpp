@@ -1,5 +1,7 @@
 #pragma once
 #include "Note.hpp"
+#include "NoteIndex.hpp"
+#include "SimilarityIndex.hpp"
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -9,10 +11,13 @@ class NoteManager
 public:
     std::vector<Note> notes;
     std::string notesDirectory;
+    NoteIndex noteIndex;
+    SimilarityIndex similarityIndex;
 
     NoteManager(const std::string& dir);
     void refreshNotes();
     Note* createNote(const std::string& title);
     void deleteNote(int index);
     bool renameNote(int index, const std::string& newTitle);
+    bool saveNote(int index);
 };
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "PatternMatcher.hpp"
+#include <algorithm>
+#include <cctype>
+
+void PatternMatcher::build(const std::vector<std::string>& patterns, bool caseSensitive)
+{
+    // Class 0 stands for every byte that appears in no pattern.
+    byteClass.fill(0);
+    classCount = 1;
+    for (const std::string& pattern : patterns)
+    {
+        for (unsigned char c : pattern)
+        {
+            unsigned char key = caseSensitive ? c : (unsigned char)std::tolower(c);
+            if (byteClass[key] == 0) byteClass[key] = (uint8_t)classCount++;
+        }
+    }
+    if (!caseSensitive)
+    {
+        for (int c = 0; c < 256; c++)
+        {
+            byteClass[c] = byteClass[(unsigned char)std::tolower(c)];
+        }
+    }
+
+    // Trie first; -1 marks a missing edge.
+    transitions.assign(classCount, -1);
+    outputLength.assign(1, 0);
+    for (const std::string& pattern : patterns)
+    {
+        if (pattern.empty()) continue;
+        int state = 0;
+        for (unsigned char c : pattern)
+        {
+            int32_t& next = transitions[(size_t)state * classCount + byteClass[c]];
+            if (next < 0)
+            {
+                next = (int32_t)outputLength.size();
+                outputLength.push_back(0);
+                transitions.resize(transitions.size() + classCount, -1);
+            }
+            state = transitions[(size_t)state * classCount + byteClass[c]];
+        }
+        outputLength[state] = std::max<int32_t>(outputLength[state], (int32_t)pattern.size());
+    }
+
+    // Breadth-first pass turns the trie into a full DFA and fills the output links.
+    size_t stateCount = outputLength.size();
+    std::vector<int32_t> failure(stateCount, 0);
+    outputLink.assign(stateCount, -1);
+    std::vector<int32_t> queue;
+    queue.reserve(stateCount);
+
+    startsPattern.fill(false);
+    for (int c = 0; c < 256; c++)
+    {
+        startsPattern[c] = byteClass[c] != 0 && transitions[byteClass[c]] > 0;
+    }
+    for (int cls = 0; cls < classCount; cls++)
+    {
+        int32_t& next = transitions[cls];
+        if (next < 0) next = 0;
+        else queue.push_back(next);
+    }
+
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        int32_t state = queue[head];
+        int32_t fail = failure[state];
+        outputLink[state] = outputLength[fail] > 0 ? fail : outputLink[fail];
+
+        for (int cls = 0; cls < classCount; cls++)
+        {
+            int32_t& next = transitions[(size_t)state * classCount + cls];
+            int32_t fallback = transitions[(size_t)fail * classCount + cls];
+            if (next < 0)
+            {
+                next = fallback;
+                continue;
+            }
+            failure[next] = fallback;
+            queue.push_back(next);
+        }
+    }
+
+    firstOutput.assign(stateCount, -1);
+    for (size_t state = 1; state < stateCount; state++)
+    {
+        firstOutput[state] = outputLength[state] > 0 ? (int32_t)state : outputLink[state];
+    }
+}
+
+void PatternMatcher::findAll(std::string_view text, std::vector<Match>& matches) const
+{
+    if (transitions.empty()) return;
+
+    size_t first = matches.size();
+    int32_t state = 0;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        // At the root, skip bytes that cannot begin any pattern without walking the table.
+        if (state == 0)
+        {
+            while (i < text.size() && !startsPattern[(unsigned char)text[i]]) i++;
+            if (i == text.size()) break;
+        }
+
+        state = transitions[(size_t)state * classCount + byteClass[(unsigned char)text[i]]];
+        for (int32_t out = firstOutput[state]; out > 0; out = outputLink[out])
+        {
+            size_t length = (size_t)outputLength[out];
+            matches.push_back({ i + 1 - length, length });
+        }
+    }
+
+    // Matches come out ordered by end; keep the leftmost, then longest, and drop overlaps.
+    std::sort(matches.begin() + first, matches.end(), [](const Match& a, const Match& b)
+        {
+            return a.offset != b.offset ? a.offset < b.offset : a.length > b.length;
+        });
+    size_t nextFree = 0;
+    matches.erase(std::remove_if(matches.begin() + first, matches.end(), [&nextFree](const Match& match)
+        {
+            if (match.offset < nextFree) return true;
+            nextFree = match.offset + match.length;
+            return false;
+        }), matches.end());
+}
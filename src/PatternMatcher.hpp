@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Aho-Corasick automaton that finds any number of literal patterns in one
+// pass over the text. Bytes are mapped to equivalence classes first (folding
+// case when asked), which keeps the transition table small and makes
+// case-insensitive search work without copying the text.
+class PatternMatcher
+{
+public:
+    struct Match
+    {
+        size_t offset;
+        size_t length;
+    };
+
+    void build(const std::vector<std::string>& patterns, bool caseSensitive);
+
+    // Appends non-overlapping matches: leftmost first, longest pattern on a tie.
+    void findAll(std::string_view text, std::vector<Match>& matches) const;
+
+private:
+    std::array<uint8_t, 256> byteClass{};
+    int classCount = 1;
+    std::vector<int32_t> transitions;
+    std::array<bool, 256> startsPattern{};
+    // Length of the longest pattern ending in each state (0 if none), the
+    // nearest suffix state that also ends a pattern, and the first state to
+    // report from when the automaton enters a state (-1 if nothing ends there).
+    std::vector<int32_t> outputLength;
+    std::vector<int32_t> outputLink;
+    std::vector<int32_t> firstOutput;
+};
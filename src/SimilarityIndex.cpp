@@ -0,0 +1,304 @@
+#include "SimilarityIndex.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <thread>
+#include <unordered_set>
+
+namespace
+{
+    const int shingleWords = 3;
+
+    uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+}
+
+SimilarityIndex::SimilarityIndex()
+{
+    uint64_t state = 0x5EED5EED5EED5EEDULL;
+    for (int i = 0; i < signatureSize; i++)
+    {
+        state += 0x9E3779B97F4A7C15ULL;
+        hashA[i] = mix(state) | 1;
+        state += 0x9E3779B97F4A7C15ULL;
+        hashB[i] = mix(state);
+    }
+}
+
+bool SimilarityIndex::computeSignature(const std::string& content, Signature& signature) const
+{
+    signature.fill(UINT32_MAX);
+
+    uint64_t window[shingleWords] = {};
+    int wordsSeen = 0;
+    bool hasShingle = false;
+
+    auto addShingle = [&]()
+        {
+            uint64_t shingle = 0;
+            for (int w = 0; w < shingleWords; w++)
+            {
+                shingle = mix(shingle ^ window[(wordsSeen + w) % shingleWords]);
+            }
+            for (int i = 0; i < signatureSize; i++)
+            {
+                uint32_t value = (uint32_t)((hashA[i] * shingle + hashB[i]) >> 32);
+                signature[i] = std::min(signature[i], value);
+            }
+            hasShingle = true;
+        };
+
+    size_t i = 0;
+    while (i < content.size())
+    {
+        while (i < content.size() && !std::isalnum((unsigned char)content[i])) i++;
+        if (i >= content.size()) break;
+
+        uint64_t word = 0xCBF29CE484222325ULL;
+        while (i < content.size() && std::isalnum((unsigned char)content[i]))
+        {
+            word = (word ^ (uint64_t)std::tolower((unsigned char)content[i])) * 0x100000001B3ULL;
+            i++;
+        }
+
+        window[wordsSeen % shingleWords] = word;
+        wordsSeen++;
+        if (wordsSeen >= shingleWords) addShingle();
+    }
+
+    // Very short notes still get a single shingle of whatever words they have.
+    if (!hasShingle && wordsSeen > 0) addShingle();
+    return hasShingle;
+}
+
+uint64_t SimilarityIndex::bandKey(const Signature& signature, int band) const
+{
+    uint64_t key = 0;
+    for (int r = 0; r < rowsPerBand; r++)
+    {
+        key = mix(key ^ signature[band * rowsPerBand + r]);
+    }
+    return key;
+}
+
+void SimilarityIndex::insertBuckets(uint32_t id)
+{
+    if (!hasSignature[id]) return;
+    for (int band = 0; band < bandCount; band++)
+    {
+        buckets[band][bandKey(signatures[id], band)].push_back(id);
+    }
+}
+
+void SimilarityIndex::eraseBuckets(uint32_t id)
+{
+    if (!hasSignature[id]) return;
+    for (int band = 0; band < bandCount; band++)
+    {
+        auto it = buckets[band].find(bandKey(signatures[id], band));
+        if (it == buckets[band].end()) continue;
+        std::vector<uint32_t>& members = it->second;
+        members.erase(std::remove(members.begin(), members.end(), id), members.end());
+        if (members.empty()) buckets[band].erase(it);
+    }
+}
+
+void SimilarityIndex::rebuild(const std::vector<Note>& notes)
+{
+    for (auto& band : buckets) band.clear();
+    signatures.assign(notes.size(), Signature{});
+    hasSignature.assign(notes.size(), false);
+
+    std::vector<char> computed(notes.size(), 0);
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]()
+        {
+            for (size_t id = next.fetch_add(1); id < notes.size(); id = next.fetch_add(1))
+            {
+                computed[id] = computeSignature(notes[id].content, signatures[id]) ? 1 : 0;
+            }
+        };
+
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (unsigned int)std::min<size_t>(threadCount, std::max<size_t>(1, notes.size()));
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threadCount; t++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) thread.join();
+
+    for (uint32_t id = 0; id < (uint32_t)notes.size(); id++)
+    {
+        hasSignature[id] = computed[id] != 0;
+        insertBuckets(id);
+    }
+    revision++;
+    layoutRevision++;
+    noteRevisions.assign(notes.size(), revision);
+}
+
+void SimilarityIndex::updateNote(uint32_t id, const Note& note)
+{
+    if (id >= signatures.size())
+    {
+        signatures.resize(id + 1);
+        hasSignature.resize(id + 1, false);
+        noteRevisions.resize(id + 1, 0);
+    }
+    eraseBuckets(id);
+    hasSignature[id] = computeSignature(note.content, signatures[id]);
+    insertBuckets(id);
+    noteRevisions[id] = ++revision;
+}
+
+void SimilarityIndex::removeNote(uint32_t id)
+{
+    if (id >= signatures.size()) return;
+    eraseBuckets(id);
+    signatures.erase(signatures.begin() + id);
+    hasSignature.erase(hasSignature.begin() + id);
+    noteRevisions.erase(noteRevisions.begin() + id);
+
+    for (auto& band : buckets)
+    {
+        for (auto& [key, members] : band)
+        {
+            for (uint32_t& member : members)
+            {
+                if (member > id) member--;
+            }
+        }
+    }
+    revision++;
+    layoutRevision++;
+}
+
+float SimilarityIndex::estimate(uint32_t a, uint32_t b) const
+{
+    int same = 0;
+    for (int i = 0; i < signatureSize; i++)
+    {
+        same += signatures[a][i] == signatures[b][i];
+    }
+    return (float)same / signatureSize;
+}
+
+std::vector<SimilarNote> SimilarityIndex::related(uint32_t id, float minSimilarity, size_t limit) const
+{
+    std::vector<SimilarNote> result;
+    if (id >= signatures.size() || !hasSignature[id]) return result;
+
+    std::unordered_set<uint32_t> candidates;
+    for (int band = 0; band < bandCount; band++)
+    {
+        auto it = buckets[band].find(bandKey(signatures[id], band));
+        if (it == buckets[band].end()) continue;
+        candidates.insert(it->second.begin(), it->second.end());
+    }
+    candidates.erase(id);
+
+    for (uint32_t candidate : candidates)
+    {
+        float similarity = estimate(id, candidate);
+        if (similarity >= minSimilarity) result.push_back({ candidate, similarity });
+    }
+    std::sort(result.begin(), result.end(), [](const SimilarNote& a, const SimilarNote& b)
+        {
+            return a.similarity != b.similarity ? a.similarity > b.similarity : a.id < b.id;
+        });
+    if (result.size() > limit) result.resize(limit);
+    return result;
+}
+
+std::vector<DuplicateGroup> SimilarityIndex::duplicates(float minSimilarity) const
+{
+    // Union-find over bucket members. Each bucket keeps a few representatives
+    // and a member joins the first one it is similar to, so a bucket full of
+    // copies costs one comparison per member instead of one per pair.
+    std::vector<uint32_t> parent(signatures.size());
+    for (uint32_t id = 0; id < (uint32_t)parent.size(); id++) parent[id] = id;
+    auto find = [&parent](uint32_t id)
+        {
+            while (parent[id] != id)
+            {
+                parent[id] = parent[parent[id]];
+                id = parent[id];
+            }
+            return id;
+        };
+
+    std::unordered_set<uint64_t> dissimilar;
+    std::vector<uint32_t> representatives;
+    for (const auto& band : buckets)
+    {
+        for (const auto& [key, members] : band)
+        {
+            if (members.size() < 2) continue;
+            representatives.clear();
+            for (uint32_t member : members)
+            {
+                bool joined = false;
+                for (uint32_t representative : representatives)
+                {
+                    uint32_t a = find(member);
+                    uint32_t b = find(representative);
+                    if (a == b)
+                    {
+                        joined = true;
+                        break;
+                    }
+
+                    uint64_t pair = ((uint64_t)std::min(member, representative) << 32) | std::max(member, representative);
+                    if (dissimilar.count(pair)) continue;
+                    if (estimate(member, representative) < minSimilarity)
+                    {
+                        dissimilar.insert(pair);
+                        continue;
+                    }
+                    parent[std::max(a, b)] = std::min(a, b);
+                    joined = true;
+                    break;
+                }
+                if (!joined) representatives.push_back(member);
+            }
+        }
+    }
+
+    std::unordered_map<uint32_t, size_t> groupOfRoot;
+    std::vector<DuplicateGroup> groups;
+    for (uint32_t id = 0; id < (uint32_t)parent.size(); id++)
+    {
+        uint32_t root = find(id);
+        if (root == id) continue;
+        auto [it, inserted] = groupOfRoot.emplace(root, groups.size());
+        if (inserted)
+        {
+            groups.emplace_back();
+            groups.back().members.push_back({ root, 1.0f });
+        }
+        groups[it->second].members.push_back({ id, estimate(root, id) });
+    }
+
+    for (DuplicateGroup& group : groups)
+    {
+        std::sort(group.members.begin() + 1, group.members.end(), [](const SimilarNote& a, const SimilarNote& b)
+            {
+                return a.similarity != b.similarity ? a.similarity > b.similarity : a.id < b.id;
+            });
+    }
+    std::sort(groups.begin(), groups.end(), [](const DuplicateGroup& a, const DuplicateGroup& b)
+        {
+            if (a.members.size() != b.members.size()) return a.members.size() > b.members.size();
+            return a.members[0].id < b.members[0].id;
+        });
+    return groups;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Note.hpp"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct SimilarNote
+{
+    uint32_t id;
+    float similarity;
+};
+
+// Notes that hash as near-duplicates of each other. members[0] is the anchor;
+// every similarity is measured against it.
+struct DuplicateGroup
+{
+    std::vector<SimilarNote> members;
+};
+
+// MinHash signatures over word 3-shingles of note content, bucketed with
+// locality-sensitive hashing (bands x rows). Notes only get compared with the
+// notes they share a bucket with, so lookups never walk the whole vault.
+// Note ids are positions in NoteManager::notes.
+class SimilarityIndex
+{
+public:
+    static constexpr int signatureSize = 128;
+    static constexpr int bandCount = 32;
+    static constexpr int rowsPerBand = signatureSize / bandCount;
+
+    SimilarityIndex();
+
+    // Recomputes every signature, spread across worker threads.
+    void rebuild(const std::vector<Note>& notes);
+    void updateNote(uint32_t id, const Note& note);
+    // Drops a note and shifts the ids above it down by one, matching vector::erase.
+    void removeNote(uint32_t id);
+
+    std::vector<SimilarNote> related(uint32_t id, float minSimilarity, size_t limit) const;
+    std::vector<DuplicateGroup> duplicates(float minSimilarity) const;
+
+    // Bumped on every change.
+    uint64_t generation() const { return revision; }
+    // Bumped only when ids shift (rebuild, removeNote), which invalidates stored ids.
+    uint64_t layoutGeneration() const { return layoutRevision; }
+    // generation() at the time the note's signature last changed.
+    uint64_t noteGeneration(uint32_t id) const { return id < noteRevisions.size() ? noteRevisions[id] : 0; }
+
+private:
+    using Signature = std::array<uint32_t, signatureSize>;
+
+    std::array<uint64_t, signatureSize> hashA;
+    std::array<uint64_t, signatureSize> hashB;
+
+    std::vector<Signature> signatures;
+    std::vector<bool> hasSignature;
+    std::array<std::unordered_map<uint64_t, std::vector<uint32_t>>, bandCount> buckets;
+    std::vector<uint64_t> noteRevisions;
+    uint64_t revision = 0;
+    uint64_t layoutRevision = 0;
+
+    bool computeSignature(const std::string& content, Signature& signature) const;
+    uint64_t bandKey(const Signature& signature, int band) const;
+    void insertBuckets(uint32_t id);
+    void eraseBuckets(uint32_t id);
+    float estimate(uint32_t a, uint32_t b) const;
+};
@@ -6,13 +6,18 @@
 #include <iostream>
 
 UIManager::UIManager(NoteManager& nm) : 
-    noteManager(nm), selectedNoteIndex(-1), openDeletePopup(false), 
+    noteManager(nm), searchFilterGeneration(0), searchFilterValid(false),
+    selectedNoteIndex(-1), openDeletePopup(false), 
     openRenamePopup(false), noteIndexToRename(-1), notificationDuration(0.0f), 
-    isPreviewMode(false)
+    isPreviewMode(false), vaultSearch(nm), searchMode((int)SearchMode::Literal),
+    searchCaseSensitive(true), relatedNoteIndex(-1), relatedGeneration(0),
+    hasDuplicateReport(false), duplicateLayout(0), duplicateGeneration(0)
 {
     editorBuffer.resize(EDITOR_BUFFER_SIZE, 0);
 
     std::memset(searchBuffer, 0, sizeof(searchBuffer));
+    std::memset(findBuffer, 0, sizeof(findBuffer));
+    std::memset(replaceBuffer, 0, sizeof(replaceBuffer));
 }
 
 UIManager::~UIManager() = default;
@@ -37,11 +42,23 @@ bool UIManager::StringContainsCaseInsensitive(
     return (it != haystack.end());
 }
 
+void UIManager::UpdateSearchFilter()
+{
+    const NoteIndex& index = noteManager.noteIndex;
+    if (searchFilterQuery == searchBuffer && searchFilterGeneration == index.generation()) return;
+
+    searchFilterQuery = searchBuffer;
+    searchFilterGeneration = index.generation();
+    searchFilterValid = index.query(searchFilterQuery, searchFilter);
+}
+
 void UIManager::Render()
 {
     RenderDockSpace();
     RenderNoteList();
     RenderEditorOrPreview();
+    RenderSearchPanel();
+    RenderRelatedNotes();
     RenderPopups();
     RenderNotifications();
 }
@@ -83,16 +100,25 @@ void UIManager::RenderNoteList()
     }
 
     ImGui::SetNextItemWidth(-1);
-    ImGui::InputTextWithHint("##search", "Search notes...", searchBuffer, sizeof(searchBuffer));
+    ImGui::InputTextWithHint("##search", "Search notes... (tag:x AND status:open)", searchBuffer, sizeof(searchBuffer));
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Words match titles. Filter with key:value, tag:name or #name,\n"
+            "combined with AND, OR, NOT (or -term) and parentheses.");
+    }
+    UpdateSearchFilter();
 
     ImGui::Separator();
 
     for (int i = 0; i < (int)noteManager.notes.size(); i++)
     {
-        if (searchBuffer[0] != '\0' &&
-            !StringContainsCaseInsensitive(noteManager.notes[i].title, searchBuffer))
+        if (searchBuffer[0] != '\0')
         {
-            continue;
+            // A malformed query falls back to the plain title search.
+            bool matches = searchFilterValid
+                ? searchFilter.contains((uint32_t)i)
+                : StringContainsCaseInsensitive(noteManager.notes[i].title, searchBuffer);
+            if (!matches) continue;
         }
 
         bool isSelected = (selectedNoteIndex == i);
@@ -162,7 +188,7 @@ void UIManager::RenderEditorOrPreview()
         if (ImGui::Button("Save"))
         {
             currentNote.content = editorBuffer.data();
-            if (currentNote.save())
+            if (noteManager.saveNote(selectedNoteIndex))
             {
                 ShowNotification("Note Saved");
             }
@@ -226,7 +252,7 @@ void UIManager::RenderEditorOrPreview()
             if (ImGui::GetIO().KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_S))
             {
                 currentNote.content = editorBuffer.data();
-                if (currentNote.save())
+                if (noteManager.saveNote(selectedNoteIndex))
                 {
                     ShowNotification("Note Saved");
                 }
@@ -257,6 +283,270 @@ void UIManager::RenderEditorOrPreview()
     ImGui::End();
 }
 
+void UIManager::OpenNoteByPath(const std::string& filepath)
+{
+    for (int i = 0; i < (int)noteManager.notes.size(); i++)
+    {
+        if (noteManager.notes[i].filepath == filepath)
+        {
+            selectedNoteIndex = i;
+            std::memset(editorBuffer.data(), 0, EDITOR_BUFFER_SIZE);
+            CopyToBuffer(noteManager.notes[i].content, editorBuffer.data(), EDITOR_BUFFER_SIZE);
+            return;
+        }
+    }
+}
+
+void UIManager::RenderSearchPanel()
+{
+    ImGui::Begin("Search & Replace");
+
+    vaultSearch.pollResults(searchResults);
+    bool isRunning = vaultSearch.isRunning();
+
+    const char* modeNames[] = { "Literal", "Multi-pattern", "Regex" };
+    ImGui::SetNextItemWidth(-1);
+    ImGui::Combo("##searchMode", &searchMode, modeNames, IM_ARRAYSIZE(modeNames));
+
+    ImGui::SetNextItemWidth(-1);
+    if (searchMode == (int)SearchMode::MultiLiteral)
+    {
+        ImGui::InputTextMultiline("##find", findBuffer, sizeof(findBuffer),
+            ImVec2(-1.0f, ImGui::GetTextLineHeight() * 4.0f));
+        ImGui::TextDisabled("One pattern per line");
+    }
+    else
+    {
+        ImGui::InputTextWithHint("##find", searchMode == (int)SearchMode::Regex ? "Regex..." : "Find...",
+            findBuffer, sizeof(findBuffer));
+        if (searchMode == (int)SearchMode::Regex && ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Backreferences and lookaround are not supported.\n"
+                "Patterns that start with literal text scan fastest.");
+        }
+    }
+
+    ImGui::SetNextItemWidth(-1);
+    ImGui::InputTextWithHint("##replace",
+        searchMode == (int)SearchMode::Regex ? "Replace with ($1 for groups)..." : "Replace with...",
+        replaceBuffer, sizeof(replaceBuffer));
+    ImGui::Checkbox("Match case", &searchCaseSensitive);
+
+    if (!isRunning)
+    {
+        if (ImGui::Button("Find All"))
+        {
+            searchResults.clear();
+            if (!vaultSearch.start(findBuffer, replaceBuffer, (SearchMode)searchMode, searchCaseSensitive))
+            {
+                ShowNotification(vaultSearch.lastError(), 3.0f);
+            }
+        }
+    }
+    else if (ImGui::Button("Cancel"))
+    {
+        vaultSearch.cancel();
+        vaultSearch.pollResults(searchResults);
+    }
+
+    ImGui::SameLine();
+    ImGui::BeginDisabled(isRunning || searchResults.empty());
+    if (ImGui::Button("Replace Selected"))
+    {
+        // Hand typing in the editor over to the note, like Preview Mode does, so
+        // applyReplacements sees it as unsaved and leaves that note alone.
+        bool hasSelection = selectedNoteIndex >= 0 && selectedNoteIndex < (int)noteManager.notes.size();
+        Note* openNote = hasSelection ? &noteManager.notes[selectedNoteIndex] : nullptr;
+        if (openNote) openNote->content = editorBuffer.data();
+
+        std::vector<std::string> unsaved;
+        std::vector<std::string> written = vaultSearch.applyReplacements(searchResults, unsaved);
+        if (openNote && std::find(written.begin(), written.end(), openNote->filepath) != written.end())
+        {
+            std::memset(editorBuffer.data(), 0, EDITOR_BUFFER_SIZE);
+            CopyToBuffer(openNote->content, editorBuffer.data(), EDITOR_BUFFER_SIZE);
+        }
+
+        std::string message = "Replaced in " + std::to_string(written.size()) + " note(s)";
+        if (!unsaved.empty())
+        {
+            message += ", skipped " + std::to_string(unsaved.size()) + " with unsaved changes";
+        }
+        ShowNotification(message, unsaved.empty() ? 2.0f : 3.0f);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("All"))
+    {
+        for (SearchMatch& match : searchResults) match.selected = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("None"))
+    {
+        for (SearchMatch& match : searchResults) match.selected = false;
+    }
+    ImGui::EndDisabled();
+
+    double seconds = vaultSearch.elapsedSeconds();
+    double megabytes = vaultSearch.bytesScanned() / (1024.0 * 1024.0);
+    ImGui::TextDisabled("%d/%d notes | %d matches | %.1f MB in %.2fs%s",
+        (int)vaultSearch.filesScanned(), (int)vaultSearch.filesTotal(), (int)searchResults.size(),
+        megabytes, seconds, vaultSearch.wasTruncated() ? " | truncated" : "");
+
+    ImGui::Separator();
+
+    ImGui::BeginChild("SearchResults");
+    ImGuiListClipper clipper;
+    clipper.Begin((int)searchResults.size());
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+        {
+            SearchMatch& match = searchResults[i];
+            ImGui::PushID(i);
+            ImGui::Checkbox("##selected", &match.selected);
+            ImGui::SameLine();
+
+            std::string location = match.title + ":" + std::to_string(match.line);
+            if (ImGui::Selectable(location.c_str(), false))
+            {
+                OpenNoteByPath(match.filepath);
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("%s -> %s", match.matchedText.c_str(), match.replacement.c_str());
+            }
+
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", match.preview.c_str());
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndChild();
+
+    ImGui::End();
+}
+
+void UIManager::RenderRelatedNotes()
+{
+    ImGui::Begin("Related Notes");
+
+    const SimilarityIndex& similarity = noteManager.similarityIndex;
+    bool hasValidSelection = (selectedNoteIndex >= 0 && selectedNoteIndex < (int)noteManager.notes.size());
+
+    if (relatedNoteIndex != selectedNoteIndex || relatedGeneration != similarity.generation())
+    {
+        relatedNoteIndex = selectedNoteIndex;
+        relatedGeneration = similarity.generation();
+        relatedNotes.clear();
+        if (hasValidSelection)
+        {
+            relatedNotes = similarity.related((uint32_t)selectedNoteIndex, 0.3f, 20);
+        }
+    }
+
+    if (!hasValidSelection)
+    {
+        ImGui::TextDisabled("Select a note to see related notes...");
+    }
+    else if (relatedNotes.empty())
+    {
+        ImGui::TextDisabled("No related notes found");
+    }
+
+    int noteToOpen = -1;
+    for (const SimilarNote& related : relatedNotes)
+    {
+        if (related.id >= noteManager.notes.size()) continue;
+        ImGui::PushID((int)related.id);
+        if (ImGui::Selectable(noteManager.notes[related.id].title.c_str(), false))
+        {
+            noteToOpen = (int)related.id;
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("%d%%", (int)(related.similarity * 100.0f));
+        ImGui::PopID();
+    }
+
+    ImGui::Separator();
+
+    // Saves keep the report; only a rebuild or delete shifts the ids it points at.
+    if (hasDuplicateReport && duplicateLayout != similarity.layoutGeneration())
+    {
+        hasDuplicateReport = false;
+        duplicateGroups.clear();
+        duplicateRows.clear();
+    }
+
+    if (ImGui::Button("Find Duplicates", ImVec2(-1, 0)))
+    {
+        duplicateGroups = similarity.duplicates(0.8f);
+        duplicateLayout = similarity.layoutGeneration();
+        duplicateGeneration = similarity.generation();
+        hasDuplicateReport = true;
+
+        duplicateRows.clear();
+        for (int g = 0; g < (int)duplicateGroups.size(); g++)
+        {
+            for (int m = 0; m < (int)duplicateGroups[g].members.size(); m++)
+            {
+                duplicateRows.emplace_back(g, m);
+            }
+        }
+        ShowNotification(std::to_string(duplicateGroups.size()) + " group(s) of near-duplicates, " +
+            std::to_string(duplicateRows.size()) + " note(s)");
+    }
+
+    if (hasDuplicateReport)
+    {
+        ImGui::BeginChild("DuplicateReport");
+        ImGuiListClipper clipper;
+        clipper.Begin((int)duplicateRows.size());
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+            {
+                const DuplicateGroup& group = duplicateGroups[duplicateRows[i].first];
+                int member = duplicateRows[i].second;
+                const SimilarNote& note = group.members[member];
+                if (note.id >= noteManager.notes.size()) continue;
+
+                ImGui::PushID(i);
+                if (member == 0)
+                {
+                    ImGui::TextDisabled("%d notes", (int)group.members.size());
+                }
+                else
+                {
+                    ImGui::TextDisabled("  %d%%", (int)(note.similarity * 100.0f));
+                }
+                ImGui::SameLine();
+                if (ImGui::SmallButton(noteManager.notes[note.id].title.c_str()))
+                {
+                    noteToOpen = (int)note.id;
+                }
+                if (similarity.noteGeneration(note.id) > duplicateGeneration)
+                {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(edited)");
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip("Changed since this report was built; run Find Duplicates again to refresh it");
+                    }
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndChild();
+    }
+
+    if (noteToOpen >= 0)
+    {
+        OpenNoteByPath(noteManager.notes[noteToOpen].filepath);
+    }
+
+    ImGui::End();
+}
+
 void UIManager::RenderMarkdown()
 {
     if (selectedNoteIndex < 0 || selectedNoteIndex >= (int)noteManager.notes.size()) return;
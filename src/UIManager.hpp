@@ -1,6 +1,7 @@
 #pragma once
 #include "imgui.h"
 #include "NoteManager.hpp"
+#include "VaultSearch.hpp"
 #include <string>
 
 #define EDITOR_BUFFER_SIZE (1024 * 256)
@@ -17,6 +18,11 @@ private:
     NoteManager& noteManager;
     std::vector<char> editorBuffer;
     char searchBuffer[128];
+    CompressedBitset searchFilter;
+    std::string searchFilterQuery;
+    uint64_t searchFilterGeneration;
+    bool searchFilterValid;
+    void UpdateSearchFilter();
     int selectedNoteIndex;
 
     bool openDeletePopup;
@@ -31,6 +37,7 @@ private:
     void RenderEditorOrPreview();
     void RenderPopups();
     void RenderNotifications();
+    void RenderSearchPanel();
 
     bool isPreviewMode;
     void RenderMarkdown();
@@ -38,4 +45,23 @@ private:
     std::string notificationMessage;
     float notificationDuration;
     void ShowNotification(const std::string& message, float duration = 2.0f);
+
+    VaultSearch vaultSearch;
+    std::vector<SearchMatch> searchResults;
+    char findBuffer[1024];
+    char replaceBuffer[256];
+    int searchMode;
+    bool searchCaseSensitive;
+    void OpenNoteByPath(const std::string& filepath);
+
+    std::vector<SimilarNote> relatedNotes;
+    int relatedNoteIndex;
+    uint64_t relatedGeneration;
+    std::vector<DuplicateGroup> duplicateGroups;
+    // One (group, member) entry per report line, so the clipper can skip whole groups.
+    std::vector<std::pair<int, int>> duplicateRows;
+    bool hasDuplicateReport;
+    uint64_t duplicateLayout;
+    uint64_t duplicateGeneration;
+    void RenderRelatedNotes();
 };
@@ -0,0 +1,354 @@
+#include "VaultSearch.hpp"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string_view>
+
+namespace
+{
+    struct Hit
+    {
+        size_t offset;
+        size_t length;
+        std::string replacement;
+    };
+
+    const size_t previewContext = 40;
+    const size_t previewMaxLength = 160;
+
+    void findLiteral(std::string_view haystack, std::string_view needle,
+        const std::string& replacement, std::vector<Hit>& hits)
+    {
+        size_t pos = haystack.find(needle);
+        while (pos != std::string_view::npos)
+        {
+            hits.push_back({ pos, needle.size(), replacement });
+            pos = haystack.find(needle, pos + needle.size());
+        }
+    }
+
+    // Reads the way NoteManager does (text mode) so offsets line up with Note::content.
+    bool readFile(const std::string& filepath, std::string& content)
+    {
+        std::ifstream file(filepath);
+        if (!file.is_open()) return false;
+
+        std::error_code ec;
+        auto size = std::filesystem::file_size(filepath, ec);
+        if (ec) return false;
+        content.assign(size, '\0');
+        file.read(content.data(), (std::streamsize)size);
+        content.resize((size_t)file.gcount());
+        return true;
+    }
+
+    std::string makePreview(const std::string& content, size_t offset, size_t length)
+    {
+        size_t lineStart = content.rfind('\n', offset == 0 ? 0 : offset - 1);
+        lineStart = (lineStart == std::string::npos || offset == 0) ? 0 : lineStart + 1;
+        size_t lineEnd = content.find('\n', offset + length);
+        if (lineEnd == std::string::npos) lineEnd = content.size();
+
+        size_t from = std::max(lineStart, offset > previewContext ? offset - previewContext : 0);
+        size_t to = std::min(lineEnd, from + previewMaxLength);
+        to = std::max(to, std::min(lineEnd, offset + length));
+
+        std::string preview = content.substr(from, to - from);
+        std::replace(preview.begin(), preview.end(), '\t', ' ');
+        std::replace(preview.begin(), preview.end(), '\r', ' ');
+        std::replace(preview.begin(), preview.end(), '\n', ' ');
+        if (from > lineStart) preview.insert(0, "...");
+        if (to < lineEnd) preview += "...";
+        return preview;
+    }
+}
+
+VaultSearch::VaultSearch(NoteManager& nm) : noteManager(nm)
+{
+}
+
+VaultSearch::~VaultSearch()
+{
+    cancel();
+}
+
+bool VaultSearch::start(const std::string& newPattern, const std::string& newReplacement,
+    SearchMode newMode, bool newCaseSensitive)
+{
+    cancel();
+
+    errorMessage.clear();
+    pattern = newPattern;
+    replacement = newReplacement;
+    mode = newMode;
+    caseSensitive = newCaseSensitive;
+    patterns.clear();
+
+    if (mode == SearchMode::Regex)
+    {
+        std::string error;
+        if (!regex.compile(pattern, caseSensitive, error))
+        {
+            errorMessage = "Invalid regex: " + error;
+            return false;
+        }
+    }
+    else
+    {
+        std::stringstream ss(pattern);
+        std::string line;
+        while (std::getline(ss, line))
+        {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            patterns.push_back(line);
+            if (mode == SearchMode::Literal) break;
+        }
+        if (patterns.empty())
+        {
+            errorMessage = "Nothing to search for";
+            return false;
+        }
+        matcher.build(patterns, caseSensitive);
+    }
+
+    targets.clear();
+    for (const Note& note : noteManager.notes)
+    {
+        targets.push_back({ note.filepath, note.title });
+    }
+
+    totalFiles = targets.size();
+    nextTarget = 0;
+    scannedFiles = 0;
+    foundMatches = 0;
+    scannedBytes = 0;
+    truncated = false;
+    cancelRequested = false;
+    finalDuration = 0.0;
+    startTime = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending.clear();
+    }
+
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (unsigned int)std::min<size_t>(threadCount, std::max<size_t>(1, totalFiles));
+
+    activeWorkers = (int)threadCount;
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&VaultSearch::workerLoop, this);
+    }
+    return true;
+}
+
+void VaultSearch::cancel()
+{
+    cancelRequested = true;
+    joinWorkers();
+}
+
+void VaultSearch::joinWorkers()
+{
+    for (std::thread& worker : workers)
+    {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+}
+
+bool VaultSearch::isRunning() const
+{
+    return activeWorkers.load() > 0;
+}
+
+double VaultSearch::elapsedSeconds() const
+{
+    if (!isRunning()) return finalDuration.load();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool VaultSearch::pollResults(std::vector<SearchMatch>& out)
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    if (pending.empty()) return false;
+    out.insert(out.end(), std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.end()));
+    pending.clear();
+    return true;
+}
+
+void VaultSearch::workerLoop()
+{
+    std::vector<SearchMatch> found;
+    while (!cancelRequested)
+    {
+        size_t index = nextTarget.fetch_add(1);
+        if (index >= targets.size()) break;
+
+        scanFile(targets[index], found);
+        scannedFiles.fetch_add(1);
+        if (!found.empty()) flush(found);
+    }
+
+    finalDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    activeWorkers.fetch_sub(1);
+}
+
+void VaultSearch::flush(std::vector<SearchMatch>& found)
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.insert(pending.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+    found.clear();
+}
+
+void VaultSearch::scanFile(const ScanTarget& target, std::vector<SearchMatch>& found)
+{
+    std::string content;
+    if (!readFile(target.filepath, content)) return;
+    scannedBytes.fetch_add(content.size());
+
+    std::vector<Hit> hits;
+    if (mode == SearchMode::Regex)
+    {
+        std::vector<LinearRegex::Match> matches;
+        regex.findAll(content, matches);
+        for (const LinearRegex::Match& m : matches)
+        {
+            hits.push_back({ m.offset, m.length, LinearRegex::format(content, m, replacement) });
+        }
+    }
+    else if (patterns.size() == 1 && caseSensitive)
+    {
+        findLiteral(content, patterns[0], replacement, hits);
+    }
+    else
+    {
+        std::vector<PatternMatcher::Match> matches;
+        matcher.findAll(content, matches);
+        for (const PatternMatcher::Match& m : matches)
+        {
+            hits.push_back({ m.offset, m.length, replacement });
+        }
+    }
+
+    if (hits.empty()) return;
+
+    size_t budget = 0;
+    size_t previous = foundMatches.fetch_add(hits.size());
+    if (previous < maxResults) budget = std::min(hits.size(), maxResults - previous);
+    if (budget < hits.size())
+    {
+        truncated = true;
+        cancelRequested = true;
+    }
+
+    int line = 1;
+    size_t cursor = 0;
+    for (size_t i = 0; i < budget; i++)
+    {
+        const Hit& hit = hits[i];
+        line += (int)std::count(content.begin() + cursor, content.begin() + hit.offset, '\n');
+        cursor = hit.offset;
+
+        SearchMatch match;
+        match.filepath = target.filepath;
+        match.title = target.title;
+        match.offset = hit.offset;
+        match.length = hit.length;
+        match.line = line;
+        match.matchedText = content.substr(hit.offset, hit.length);
+        match.replacement = hit.replacement;
+        match.preview = makePreview(content, hit.offset, hit.length);
+        found.push_back(std::move(match));
+    }
+}
+
+std::vector<std::string> VaultSearch::applyReplacements(std::vector<SearchMatch>& results,
+    std::vector<std::string>& unsaved)
+{
+    std::vector<std::string> written;
+    if (isRunning()) return written;
+    joinWorkers();
+
+    std::map<std::string, std::vector<size_t>> byFile;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        if (results[i].selected) byFile[results[i].filepath].push_back(i);
+    }
+
+    std::vector<bool> applied(results.size(), false);
+
+    for (auto& [filepath, indices] : byFile)
+    {
+        auto noteIt = std::find_if(noteManager.notes.begin(), noteManager.notes.end(),
+            [&filepath](const Note& note) { return note.filepath == filepath; });
+        if (noteIt == noteManager.notes.end()) continue;
+
+        // Apply back to front so earlier offsets stay valid while editing.
+        std::sort(indices.begin(), indices.end(), [&results](size_t a, size_t b)
+            {
+                return results[a].offset > results[b].offset;
+            });
+
+        // Offsets came from the file on disk. A note whose text in memory differs
+        // from it has unsaved edits, and writing it would save them behind the user's back.
+        std::string content;
+        if (!readFile(filepath, content)) continue;
+        if (noteIt->content != content)
+        {
+            unsaved.push_back(filepath);
+            continue;
+        }
+
+        size_t limit = content.size();
+        std::vector<std::pair<size_t, long long>> shifts;
+        for (size_t index : indices)
+        {
+            const SearchMatch& match = results[index];
+            if (match.offset + match.length > limit) continue;
+            if (content.compare(match.offset, match.length, match.matchedText) != 0) continue;
+
+            content.replace(match.offset, match.length, match.replacement);
+            shifts.emplace_back(match.offset, (long long)match.replacement.size() - (long long)match.length);
+            limit = match.offset;
+            applied[index] = true;
+        }
+
+        if (shifts.empty()) continue;
+
+        std::string original = std::move(noteIt->content);
+        noteIt->content = std::move(content);
+        if (!noteManager.saveNote((int)(noteIt - noteManager.notes.begin())))
+        {
+            noteIt->content = std::move(original);
+            for (size_t index : indices) applied[index] = false;
+            continue;
+        }
+        written.push_back(filepath);
+
+        // Keep the remaining matches of this file pointing at the right place.
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            SearchMatch& match = results[i];
+            if (applied[i] || match.filepath != filepath) continue;
+            long long delta = 0;
+            for (const auto& [offset, change] : shifts)
+            {
+                if (offset < match.offset) delta += change;
+            }
+            match.offset = (size_t)((long long)match.offset + delta);
+        }
+    }
+
+    size_t out = 0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        if (applied[i]) continue;
+        if (out != i) results[out] = std::move(results[i]);
+        out++;
+    }
+    results.resize(out);
+    return written;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "NoteManager.hpp"
+#include "LinearRegex.hpp"
+#include "PatternMatcher.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class SearchMode
+{
+    Literal,
+    MultiLiteral,
+    Regex
+};
+
+struct SearchMatch
+{
+    std::string filepath;
+    std::string title;
+    size_t offset = 0;
+    size_t length = 0;
+    int line = 0;
+    std::string matchedText;
+    std::string replacement;
+    std::string preview;
+    bool selected = true;
+};
+
+// Scans every note file of the vault on a pool of worker threads. Matches are
+// queued as they are found and handed to the UI thread through pollResults(),
+// so the results panel fills in while the scan is still running.
+class VaultSearch
+{
+public:
+    static constexpr size_t maxResults = 100000;
+
+    VaultSearch(NoteManager& noteManager);
+    ~VaultSearch();
+
+    bool start(const std::string& pattern, const std::string& replacement,
+        SearchMode mode, bool caseSensitive);
+    void cancel();
+    bool isRunning() const;
+
+    // Moves matches found since the last call into 'out'. Returns true if any were added.
+    bool pollResults(std::vector<SearchMatch>& out);
+
+    // Rewrites every file that has at least one selected match, one write per file.
+    // Matches whose text no longer sits at the recorded offset are skipped, and so
+    // are notes with unsaved changes; their paths are appended to 'unsaved'.
+    // Returns the paths of the notes that were written.
+    std::vector<std::string> applyReplacements(std::vector<SearchMatch>& results,
+        std::vector<std::string>& unsaved);
+
+    size_t filesTotal() const { return totalFiles; }
+    size_t filesScanned() const { return scannedFiles.load(); }
+    uint64_t bytesScanned() const { return scannedBytes.load(); }
+    double elapsedSeconds() const;
+    bool wasTruncated() const { return truncated.load(); }
+    const std::string& lastError() const { return errorMessage; }
+
+private:
+    struct ScanTarget
+    {
+        std::string filepath;
+        std::string title;
+    };
+
+    NoteManager& noteManager;
+    std::vector<ScanTarget> targets;
+    std::vector<std::thread> workers;
+
+    std::string pattern;
+    std::string replacement;
+    std::vector<std::string> patterns;
+    LinearRegex regex;
+    PatternMatcher matcher;
+    SearchMode mode = SearchMode::Literal;
+    bool caseSensitive = true;
+    std::string errorMessage;
+
+    size_t totalFiles = 0;
+    std::atomic<size_t> nextTarget{ 0 };
+    std::atomic<size_t> scannedFiles{ 0 };
+    std::atomic<size_t> foundMatches{ 0 };
+    std::atomic<uint64_t> scannedBytes{ 0 };
+    std::atomic<int> activeWorkers{ 0 };
+    std::atomic<bool> cancelRequested{ false };
+    std::atomic<bool> truncated{ false };
+    std::atomic<double> finalDuration{ 0.0 };
+    std::chrono::steady_clock::time_point startTime;
+
+    std::mutex pendingMutex;
+    std::vector<SearchMatch> pending;
+
+    void joinWorkers();
+    void workerLoop();
+    void scanFile(const ScanTarget& target, std::vector<SearchMatch>& found);
+    void flush(std::vector<SearchMatch>& found);
+};